@@ -16,6 +16,12 @@
 #define DEFAULT_DELAY_TIME 3
 #define COLOR_DEPTH 256
 #define MAX_REGIONS 10
+#define MAX_PYRAMID_LEVELS 16
+#define PYRAMID_TILE_SIZE 512
+#define TILE_KEEP_MARGIN 1
+#define ZOOM_STEP 1.25f
+#define MAX_ZOOM 4.0f
+#define PAN_STEP 64.0f
 
 typedef struct {
     unsigned char *data;
@@ -42,6 +48,14 @@ typedef struct {
     Color average;
 } ColorBox;
 
+typedef struct {
+    Image levels[MAX_PYRAMID_LEVELS];
+    SDL_Texture **tiles[MAX_PYRAMID_LEVELS];
+    int tiles_x[MAX_PYRAMID_LEVELS];
+    int tiles_y[MAX_PYRAMID_LEVELS];
+    int level_count;
+} ImagePyramid;
+
 struct my_error_mgr {
     struct jpeg_error_mgr pub;
     jmp_buf setjmp_buffer;
@@ -92,6 +106,8 @@ static Image load_jpeg(const char *filename) {
         exit(EXIT_FAILURE);
     }
 
+    cinfo.out_color_space = cinfo.jpeg_color_space == JCS_GRAYSCALE ? JCS_GRAYSCALE : JCS_RGB;
+
     jpeg_start_decompress(&cinfo);
 
     Image img = {
@@ -119,24 +135,39 @@ static Image load_jpeg(const char *filename) {
     return img;
 }
 
-static SDL_Surface* image_to_sdl_surface(const Image *img) {
-    if (img->channels != 3) {
-        fprintf(stderr, "Unsupported number of channels: %d. Only RGB images are supported.\n", img->channels);
+static SDL_Surface* image_to_sdl_surface(const Image *img, int x, int y, int w, int h) {
+    SDL_Surface *surface = NULL;
+    unsigned char *pixels = img->data + (y * img->width + x) * img->channels;
+
+    if (img->channels == 3) {
+        surface = SDL_CreateRGBSurfaceFrom(
+            pixels,
+            w,
+            h,
+            img->channels * 8,
+            img->width * img->channels,
+            0x0000FF,
+            0x00FF00,
+            0xFF0000,
+            0
+        );
+    }
+    else if (img->channels == 1) {
+        surface = SDL_CreateRGBSurfaceFrom(pixels, w, h, 8, img->width, 0, 0, 0, 0);
+        if (surface) {
+            SDL_Color gray[256];
+            for (int i = 0; i < 256; i++) {
+                gray[i].r = gray[i].g = gray[i].b = (Uint8)i;
+                gray[i].a = 255;
+            }
+            SDL_SetPaletteColors(surface->format->palette, gray, 0, 256);
+        }
+    }
+    else {
+        fprintf(stderr, "Unsupported number of channels: %d. Only RGB and grayscale images are supported.\n", img->channels);
         return NULL;
     }
 
-    SDL_Surface *surface = SDL_CreateRGBSurfaceFrom(
-        img->data,
-        img->width,
-        img->height,
-        img->channels * 8,
-        img->width * img->channels,
-        0x0000FF,
-        0x00FF00,
-        0xFF0000,
-        0
-    );
-
     if (!surface) {
         fprintf(stderr, "SDL_CreateRGBSurfaceFrom Error: %s\n", SDL_GetError());
         return NULL;
@@ -145,15 +176,212 @@ static SDL_Surface* image_to_sdl_surface(const Image *img) {
     return surface;
 }
 
-static int select_regions(SDL_Surface *image, MotionRegion *regions, int max_regions, int motion_mode) {
+static int downsample_image(const Image *src, Image *dst) {
+    dst->width = src->width > 1 ? src->width / 2 : 1;
+    dst->height = src->height > 1 ? src->height / 2 : 1;
+    dst->channels = src->channels;
+    dst->data = malloc(dst->width * dst->height * dst->channels);
+    if (!dst->data) {
+        fprintf(stderr, "Error allocating memory for pyramid level\n");
+        return -1;
+    }
+
+    for (int y = 0; y < dst->height; y++) {
+        int y0 = y * 2;
+        int y1 = y0 + 1 < src->height ? y0 + 1 : y0;
+        for (int x = 0; x < dst->width; x++) {
+            int x0 = x * 2;
+            int x1 = x0 + 1 < src->width ? x0 + 1 : x0;
+            for (int c = 0; c < src->channels; c++) {
+                int sum = src->data[(y0 * src->width + x0) * src->channels + c]
+                        + src->data[(y0 * src->width + x1) * src->channels + c]
+                        + src->data[(y1 * src->width + x0) * src->channels + c]
+                        + src->data[(y1 * src->width + x1) * src->channels + c];
+                dst->data[(y * dst->width + x) * dst->channels + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return 0;
+}
+
+static void free_pyramid(ImagePyramid *pyr) {
+    for (int l = 0; l < pyr->level_count; l++) {
+        if (pyr->tiles[l]) {
+            for (int t = 0; t < pyr->tiles_x[l] * pyr->tiles_y[l]; t++) {
+                if (pyr->tiles[l][t])
+                    SDL_DestroyTexture(pyr->tiles[l][t]);
+            }
+            free(pyr->tiles[l]);
+        }
+        if (l > 0)
+            free(pyr->levels[l].data);
+    }
+    pyr->level_count = 0;
+}
+
+/* Level 0 borrows the source pixels; each further level halves the previous
+ * one until it fits inside max_w x max_h. Textures are created per tile when
+ * a tile becomes visible and released again by evict_tiles. */
+static int build_pyramid(const Image *src, int max_w, int max_h, ImagePyramid *pyr) {
+    memset(pyr, 0, sizeof(*pyr));
+    pyr->levels[0] = *src;
+    pyr->level_count = 1;
+
+    while (pyr->level_count < MAX_PYRAMID_LEVELS) {
+        const Image *prev = &pyr->levels[pyr->level_count - 1];
+        if (prev->width <= max_w && prev->height <= max_h)
+            break;
+        if (downsample_image(prev, &pyr->levels[pyr->level_count]) != 0) {
+            free_pyramid(pyr);
+            return -1;
+        }
+        pyr->level_count++;
+    }
+
+    for (int l = 0; l < pyr->level_count; l++) {
+        pyr->tiles_x[l] = (pyr->levels[l].width + PYRAMID_TILE_SIZE - 1) / PYRAMID_TILE_SIZE;
+        pyr->tiles_y[l] = (pyr->levels[l].height + PYRAMID_TILE_SIZE - 1) / PYRAMID_TILE_SIZE;
+        pyr->tiles[l] = calloc(pyr->tiles_x[l] * pyr->tiles_y[l], sizeof(SDL_Texture *));
+        if (!pyr->tiles[l]) {
+            fprintf(stderr, "Error allocating memory for pyramid tiles\n");
+            free_pyramid(pyr);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static SDL_Texture *pyramid_tile(SDL_Renderer *ren, ImagePyramid *pyr, int level, int tx, int ty) {
+    SDL_Texture **slot = &pyr->tiles[level][ty * pyr->tiles_x[level] + tx];
+    if (*slot)
+        return *slot;
+
+    const Image *img = &pyr->levels[level];
+    int x = tx * PYRAMID_TILE_SIZE;
+    int y = ty * PYRAMID_TILE_SIZE;
+    int w = img->width - x < PYRAMID_TILE_SIZE ? img->width - x : PYRAMID_TILE_SIZE;
+    int h = img->height - y < PYRAMID_TILE_SIZE ? img->height - y : PYRAMID_TILE_SIZE;
+
+    SDL_Surface *surface = image_to_sdl_surface(img, x, y, w, h);
+    if (!surface)
+        return NULL;
+
+    *slot = SDL_CreateTextureFromSurface(ren, surface);
+    if (!*slot)
+        fprintf(stderr, "SDL_CreateTextureFromSurface Error: %s\n", SDL_GetError());
+    SDL_FreeSurface(surface);
+    return *slot;
+}
+
+/* Destroys every resident tile texture except those of `level` within one
+ * tile of the visible range, so memory stays bounded by the window size
+ * however far the view is zoomed or panned. */
+static void evict_tiles(ImagePyramid *pyr, int level, int tx0, int ty0, int tx1, int ty1) {
+    for (int l = 0; l < pyr->level_count; l++) {
+        for (int ty = 0; ty < pyr->tiles_y[l]; ty++) {
+            for (int tx = 0; tx < pyr->tiles_x[l]; tx++) {
+                SDL_Texture **slot = &pyr->tiles[l][ty * pyr->tiles_x[l] + tx];
+                if (!*slot)
+                    continue;
+                if (l == level && tx >= tx0 - TILE_KEEP_MARGIN && tx <= tx1 + TILE_KEEP_MARGIN
+                        && ty >= ty0 - TILE_KEEP_MARGIN && ty <= ty1 + TILE_KEEP_MARGIN)
+                    continue;
+                SDL_DestroyTexture(*slot);
+                *slot = NULL;
+            }
+        }
+    }
+}
+
+/* Draws the coarsest pyramid level that still has at least one texel per
+ * screen pixel at the current zoom. view_x/view_y are full-resolution
+ * coordinates of the window's top-left corner. */
+static int render_pyramid(SDL_Renderer *ren, ImagePyramid *pyr, int win_w, int win_h, float view_x, float view_y, float view_scale) {
+    int level = 0;
+    while (level + 1 < pyr->level_count && (float)pyr->levels[level + 1].width / pyr->levels[0].width >= view_scale)
+        level++;
+
+    const Image *img = &pyr->levels[level];
+    float sx = (float)img->width / pyr->levels[0].width;
+    float sy = (float)img->height / pyr->levels[0].height;
+
+    int tx0 = (int)(view_x * sx) / PYRAMID_TILE_SIZE;
+    int ty0 = (int)(view_y * sy) / PYRAMID_TILE_SIZE;
+    int tx1 = (int)((view_x + win_w / view_scale) * sx) / PYRAMID_TILE_SIZE;
+    int ty1 = (int)((view_y + win_h / view_scale) * sy) / PYRAMID_TILE_SIZE;
+    if (tx0 < 0) tx0 = 0;
+    if (ty0 < 0) ty0 = 0;
+    if (tx1 >= pyr->tiles_x[level]) tx1 = pyr->tiles_x[level] - 1;
+    if (ty1 >= pyr->tiles_y[level]) ty1 = pyr->tiles_y[level] - 1;
+
+    evict_tiles(pyr, level, tx0, ty0, tx1, ty1);
+
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            SDL_Texture *tex = pyramid_tile(ren, pyr, level, tx, ty);
+            if (!tex)
+                return -1;
+
+            int lx0 = tx * PYRAMID_TILE_SIZE;
+            int ly0 = ty * PYRAMID_TILE_SIZE;
+            int lx1 = lx0 + PYRAMID_TILE_SIZE < img->width ? lx0 + PYRAMID_TILE_SIZE : img->width;
+            int ly1 = ly0 + PYRAMID_TILE_SIZE < img->height ? ly0 + PYRAMID_TILE_SIZE : img->height;
+
+            int dx0 = (int)lroundf((lx0 / sx - view_x) * view_scale);
+            int dy0 = (int)lroundf((ly0 / sy - view_y) * view_scale);
+            int dx1 = (int)lroundf((lx1 / sx - view_x) * view_scale);
+            int dy1 = (int)lroundf((ly1 / sy - view_y) * view_scale);
+            SDL_Rect dst = {dx0, dy0, dx1 - dx0, dy1 - dy0};
+            SDL_RenderCopy(ren, tex, NULL, &dst);
+        }
+    }
+    return 0;
+}
+
+static void clamp_view(const Image *image, int win_w, int win_h, float view_scale, float *view_x, float *view_y) {
+    float max_x = image->width - win_w / view_scale;
+    float max_y = image->height - win_h / view_scale;
+    *view_x = *view_x > max_x ? max_x : *view_x;
+    *view_y = *view_y > max_y ? max_y : *view_y;
+    *view_x = *view_x < 0.0f ? 0.0f : *view_x;
+    *view_y = *view_y < 0.0f ? 0.0f : *view_y;
+}
+
+static int select_regions(const Image *image, MotionRegion *regions, int max_regions, int motion_mode) {
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
         return -1;
     }
 
-    SDL_Window *win = SDL_CreateWindow("Select Motion Regions", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, image->w, image->h, SDL_WINDOW_SHOWN);
+    int max_w = image->width;
+    int max_h = image->height;
+    SDL_DisplayMode mode;
+    if (SDL_GetDesktopDisplayMode(0, &mode) == 0) {
+        max_w = mode.w * 9 / 10;
+        max_h = mode.h * 9 / 10;
+    }
+
+    float fit_scale = 1.0f;
+    if (image->width > max_w || image->height > max_h) {
+        float fx = (float)max_w / image->width;
+        float fy = (float)max_h / image->height;
+        fit_scale = fx < fy ? fx : fy;
+    }
+    int win_w = (int)(image->width * fit_scale);
+    int win_h = (int)(image->height * fit_scale);
+    if (win_w < 1) win_w = 1;
+    if (win_h < 1) win_h = 1;
+
+    ImagePyramid pyr;
+    if (build_pyramid(image, win_w, win_h, &pyr) != 0) {
+        SDL_Quit();
+        return -1;
+    }
+
+    SDL_Window *win = SDL_CreateWindow("Select Motion Regions", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, win_w, win_h, SDL_WINDOW_SHOWN);
     if (win == NULL) {
         fprintf(stderr, "SDL_CreateWindow Error: %s\n", SDL_GetError());
+        free_pyramid(&pyr);
         SDL_Quit();
         return -1;
     }
@@ -162,15 +390,7 @@ static int select_regions(SDL_Surface *image, MotionRegion *regions, int max_reg
     if (ren == NULL) {
         SDL_DestroyWindow(win);
         fprintf(stderr, "SDL_CreateRenderer Error: %s\n", SDL_GetError());
-        SDL_Quit();
-        return -1;
-    }
-
-    SDL_Texture *tex = SDL_CreateTextureFromSurface(ren, image);
-    if (tex == NULL) {
-        SDL_DestroyRenderer(ren);
-        SDL_DestroyWindow(win);
-        fprintf(stderr, "SDL_CreateTextureFromSurface Error: %s\n", SDL_GetError());
+        free_pyramid(&pyr);
         SDL_Quit();
         return -1;
     }
@@ -178,13 +398,17 @@ static int select_regions(SDL_Surface *image, MotionRegion *regions, int max_reg
     int running = 1;
     SDL_Event e;
     int selecting = 0;
+    int panning = 0;
     int start_x = 0, start_y = 0, end_x = 0, end_y = 0;
     SDL_Rect current_rect = {0, 0, 0, 0};
     int region_count = 0;
+    float view_scale = fit_scale;
+    float view_x = 0.0f, view_y = 0.0f;
 
     printf("Instructions:\n");
     printf("  - Click and drag the mouse to select a circular region.\n");
     printf("  - Repeat to select up to %d regions.\n", max_regions);
+    printf("  - Scroll to zoom, drag with the right mouse button or use the arrow keys to pan.\n");
     printf("  - Press ESC or close the window to finish selection.\n");
 
     while (running && region_count < max_regions) {
@@ -195,7 +419,49 @@ static int select_regions(SDL_Surface *image, MotionRegion *regions, int max_reg
             else if (e.type == SDL_KEYDOWN) {
                 if (e.key.keysym.sym == SDLK_ESCAPE) {
                     running = 0;
+                    continue;
+                }
+                if (selecting)
+                    continue;
+
+                float step = PAN_STEP / view_scale;
+                switch (e.key.keysym.sym) {
+                    case SDLK_LEFT:   view_x -= step; break;
+                    case SDLK_RIGHT:  view_x += step; break;
+                    case SDLK_UP:     view_y -= step; break;
+                    case SDLK_DOWN:   view_y += step; break;
+                    default: break;
                 }
+                clamp_view(image, win_w, win_h, view_scale, &view_x, &view_y);
+            }
+            else if (e.type == SDL_MOUSEWHEEL && !selecting) {
+                int wheel_y = e.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -e.wheel.y : e.wheel.y;
+                if (wheel_y == 0)
+                    continue;
+
+                int mouse_x, mouse_y;
+                SDL_GetMouseState(&mouse_x, &mouse_y);
+                float anchor_x = view_x + mouse_x / view_scale;
+                float anchor_y = view_y + mouse_y / view_scale;
+
+                view_scale *= wheel_y > 0 ? ZOOM_STEP : 1.0f / ZOOM_STEP;
+                if (view_scale < fit_scale) view_scale = fit_scale;
+                if (view_scale > MAX_ZOOM) view_scale = MAX_ZOOM;
+
+                view_x = anchor_x - mouse_x / view_scale;
+                view_y = anchor_y - mouse_y / view_scale;
+                clamp_view(image, win_w, win_h, view_scale, &view_x, &view_y);
+            }
+            else if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_RIGHT && !selecting) {
+                panning = 1;
+            }
+            else if (e.type == SDL_MOUSEBUTTONUP && e.button.button == SDL_BUTTON_RIGHT) {
+                panning = 0;
+            }
+            else if (e.type == SDL_MOUSEMOTION && panning && !selecting) {
+                view_x -= e.motion.xrel / view_scale;
+                view_y -= e.motion.yrel / view_scale;
+                clamp_view(image, win_w, win_h, view_scale, &view_x, &view_y);
             }
             else if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT) {
                 selecting = 1;
@@ -217,9 +483,10 @@ static int select_regions(SDL_Surface *image, MotionRegion *regions, int max_reg
                 end_x = e.button.x;
                 end_y = e.button.y;
 
-                int center_x = (start_x + end_x) / 2;
-                int center_y = (start_y + end_y) / 2;
-                int radius = (int)sqrt((start_x - end_x) * (start_x - end_x) + (start_y - end_y) * (start_y - end_y)) / 2;
+                float screen_radius = sqrtf((float)((start_x - end_x) * (start_x - end_x) + (start_y - end_y) * (start_y - end_y))) / 2.0f;
+                int center_x = (int)(view_x + (start_x + end_x) / (2.0f * view_scale));
+                int center_y = (int)(view_y + (start_y + end_y) / (2.0f * view_scale));
+                int radius = (int)(screen_radius / view_scale);
 
                 if (radius <= 0) {
                     printf("Invalid region selected. Please select a larger area.\n");
@@ -254,8 +521,12 @@ static int select_regions(SDL_Surface *image, MotionRegion *regions, int max_reg
             }
         }
 
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
         SDL_RenderClear(ren);
-        SDL_RenderCopy(ren, tex, NULL, NULL);
+        if (render_pyramid(ren, &pyr, win_w, win_h, view_x, view_y, view_scale) != 0) {
+            region_count = -1;
+            break;
+        }
 
         if (selecting) {
             SDL_SetRenderDrawColor(ren, 255, 0, 0, 255);
@@ -274,7 +545,7 @@ static int select_regions(SDL_Surface *image, MotionRegion *regions, int max_reg
         SDL_RenderPresent(ren);
     }
 
-    SDL_DestroyTexture(tex);
+    free_pyramid(&pyr);
     SDL_DestroyRenderer(ren);
     SDL_DestroyWindow(win);
     SDL_Quit();
@@ -417,6 +688,11 @@ static void compute_average(ColorBox *box) {
 }
 
 static ColorMapObject* median_cut(const Image *frame, int color_depth) {
+    if (frame->channels != 3) {
+        fprintf(stderr, "Median cut requires an RGB frame, got %d channel(s)\n", frame->channels);
+        return NULL;
+    }
+
     Color *all_colors = malloc(frame->width * frame->height * sizeof(Color));
     if (!all_colors) {
         fprintf(stderr, "Error allocating memory for all_colors\n");
@@ -502,11 +778,48 @@ static ColorMapObject* median_cut(const Image *frame, int color_depth) {
     return colormap;
 }
 
+static ColorMapObject *gray_ramp(void) {
+    ColorMapObject *colormap = GifMakeMapObject(COLOR_DEPTH, NULL);
+    if (!colormap)
+        return NULL;
+
+    for (int i = 0; i < COLOR_DEPTH; i++) {
+        colormap->Colors[i].Red = i;
+        colormap->Colors[i].Green = i;
+        colormap->Colors[i].Blue = i;
+    }
+    colormap->ColorCount = COLOR_DEPTH;
+    return colormap;
+}
+
+static int is_gray_ramp(const ColorMapObject *colormap) {
+    if (colormap->ColorCount != COLOR_DEPTH)
+        return 0;
+
+    for (int i = 0; i < COLOR_DEPTH; i++) {
+        if (colormap->Colors[i].Red != i || colormap->Colors[i].Green != i || colormap->Colors[i].Blue != i)
+            return 0;
+    }
+    return 1;
+}
+
 static GifByteType *create_color_index_buffer(const Image *frame, const ColorMapObject *colormap) {
     GifByteType *buffer = malloc(frame->width * frame->height);
     if (!buffer)
         die("Error allocating color index buffer");
 
+    if (frame->channels == 1) {
+        if (!is_gray_ramp(colormap)) {
+            fprintf(stderr, "Grayscale frames can only be indexed against the gray ramp\n");
+            free(buffer);
+            return NULL;
+        }
+
+        /* Entry i of the gray ramp is gray level i, so pixels are their own index. */
+        memcpy(buffer, frame->data, frame->width * frame->height);
+        return buffer;
+    }
+
     for (int i = 0; i < frame->width * frame->height; i++) {
         int offset = i * frame->channels;
         int minDist = INT32_MAX;
@@ -530,7 +843,14 @@ static GifByteType *create_color_index_buffer(const Image *frame, const ColorMap
     return buffer;
 }
 
-static void write_gif(const char *filename, const Image *frames, int frame_count, int delay_time) {
+static ColorMapObject *build_palette(const Image *img) {
+    return img->channels == 1 ? gray_ramp() : median_cut(img, COLOR_DEPTH);
+}
+
+/* When palette is NULL the frames hold pixels and are quantized here against
+ * a palette built from the first frame. Otherwise the frames already hold
+ * indices into palette. Either way write_gif owns the palette. */
+static void write_gif(const char *filename, const Image *frames, int frame_count, int delay_time, ColorMapObject *palette) {
     int error;
     GifFileType *gif = EGifOpenFileName(filename, false, &error);
     if (!gif) {
@@ -538,9 +858,10 @@ static void write_gif(const char *filename, const Image *frames, int frame_count
         exit(EXIT_FAILURE);
     }
 
-    ColorMapObject *colormap = median_cut(&frames[0], COLOR_DEPTH);
+    int prequantized = palette != NULL;
+    ColorMapObject *colormap = prequantized ? palette : build_palette(&frames[0]);
     if (!colormap) {
-        fprintf(stderr, "Error performing median cut color quantization\n");
+        fprintf(stderr, "Error building the color palette\n");
         EGifCloseFile(gif, &error);
         exit(EXIT_FAILURE);
     }
@@ -579,7 +900,9 @@ static void write_gif(const char *filename, const Image *frames, int frame_count
             exit(EXIT_FAILURE);
         }
 
-        GifByteType *indexed = create_color_index_buffer(&frames[i], colormap);
+        GifByteType *indexed = prequantized
+            ? frames[i].data
+            : create_color_index_buffer(&frames[i], colormap);
         if (!indexed) {
             fprintf(stderr, "Error creating color index buffer\n");
             EGifCloseFile(gif, &error);
@@ -589,7 +912,8 @@ static void write_gif(const char *filename, const Image *frames, int frame_count
 
         if (EGifPutImageDesc(gif, 0, 0, frames[i].width, frames[i].height, false, NULL) == GIF_ERROR) {
             fprintf(stderr, "Error writing image descriptor: %s\n", GifErrorString(gif->Error));
-            free(indexed);
+            if (!prequantized)
+                free(indexed);
             EGifCloseFile(gif, &error);
             GifFreeMapObject(colormap);
             exit(EXIT_FAILURE);
@@ -598,14 +922,16 @@ static void write_gif(const char *filename, const Image *frames, int frame_count
         for (int y = 0; y < frames[i].height; y++) {
             if (EGifPutLine(gif, &indexed[y * frames[i].width], frames[i].width) == GIF_ERROR) {
                 fprintf(stderr, "Error writing image data: %s\n", GifErrorString(gif->Error));
-                free(indexed);
+                if (!prequantized)
+                    free(indexed);
                 EGifCloseFile(gif, &error);
                 GifFreeMapObject(colormap);
                 exit(EXIT_FAILURE);
             }
         }
 
-        free(indexed);
+        if (!prequantized)
+            free(indexed);
     }
 
     if (EGifCloseFile(gif, &error) == GIF_ERROR) {
@@ -624,6 +950,7 @@ static void usage(const char *prog_name) {
         "  -f <frames>      Number of frames for animation (default: 24, max: 30)\n"
         "  -t <delay>       Delay time between frames in hundredths of a second (default: 3)\n"
         "  -m <mode>        Motion mode: 0 for horizontal, 1 for vertical, 2 for both (default: 2)\n"
+        "  -i               Quantize the source once and warp palette indices instead of RGB frames\n"
         "  -h               Show this help message\n",
         prog_name);
     exit(EXIT_FAILURE);
@@ -633,9 +960,10 @@ int main(int argc, char *argv[]) {
     int frame_count = DEFAULT_FRAME_COUNT;
     int delay_time = DEFAULT_DELAY_TIME;
     int motion_mode = 2;
+    int indexed_mode = 0;
     int opt;
 
-    while ((opt = getopt(argc, argv, "f:t:m:h")) != -1) {
+    while ((opt = getopt(argc, argv, "f:t:m:ih")) != -1) {
         switch (opt) {
             case 'f':
                 frame_count = atoi(optarg);
@@ -658,6 +986,9 @@ int main(int argc, char *argv[]) {
                     exit(EXIT_FAILURE);
                 }
                 break;
+            case 'i':
+                indexed_mode = 1;
+                break;
             case 'h':
             default:
                 usage(argv[0]);
@@ -672,26 +1003,48 @@ int main(int argc, char *argv[]) {
 
     Image src = load_jpeg(input_file);
 
-    SDL_Surface *src_surface = image_to_sdl_surface(&src);
-    if (!src_surface) {
-        free(src.data);
-        exit(EXIT_FAILURE);
-    }
-
     MotionRegion regions[MAX_REGIONS];
-    int num_regions = select_regions(src_surface, regions, MAX_REGIONS, motion_mode);
+    int num_regions = select_regions(&src, regions, MAX_REGIONS, motion_mode);
     if (num_regions <= 0) {
         fprintf(stderr, "No regions selected.\n");
-        SDL_FreeSurface(src_surface);
         free(src.data);
         exit(EXIT_FAILURE);
     }
 
-    SDL_FreeSurface(src_surface);
+    Image *frames;
+    ColorMapObject *palette = NULL;
+
+    if (indexed_mode) {
+        /* The warp only moves source pixels around, so indexing the source
+         * once and gathering indices per frame gives the same result as
+         * quantizing every frame. */
+        palette = build_palette(&src);
+        if (!palette) {
+            fprintf(stderr, "Error building the color palette\n");
+            free(src.data);
+            exit(EXIT_FAILURE);
+        }
 
-    Image *frames = amplify_motion(&src, frame_count, regions, num_regions);
+        Image indices = {
+            .width = src.width,
+            .height = src.height,
+            .channels = 1,
+            .data = create_color_index_buffer(&src, palette)
+        };
+        if (!indices.data) {
+            fprintf(stderr, "Error creating color index buffer\n");
+            GifFreeMapObject(palette);
+            free(src.data);
+            exit(EXIT_FAILURE);
+        }
+        frames = amplify_motion(&indices, frame_count, regions, num_regions);
+        free(indices.data);
+    }
+    else {
+        frames = amplify_motion(&src, frame_count, regions, num_regions);
+    }
 
-    write_gif(output_file, frames, frame_count, delay_time);
+    write_gif(output_file, frames, frame_count, delay_time, palette);
 
     free(src.data);
     for (int i = 0; i < frame_count; i++)